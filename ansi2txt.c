@@ -25,11 +25,13 @@
 #include <string.h>
 #include <unistd.h>
 
-#define VERSION "0.2.3"
+#define VERSION "0.2.4"
 
 #define DEFAULT_HEIGHT 60
 #define DEFAULT_WIDTH  120
 
+#define ROW_ARENA 64
+
 #define VT100_BUF 8
 #define VT100_PARAMS 10
 #define TAB 9
@@ -68,10 +70,18 @@ int32_t reverse_video = 0;
 
 int32_t  cX = 0, cY = 0;
 int32_t  max_cX = 0, max_cY = 0;
-char *out = 0, *out_mode = 0, *out_col = 0, *out_size = 0;
+char *out_size = 0;
 int32_t  width  = DEFAULT_WIDTH;
 int32_t  height = DEFAULT_HEIGHT;
 
+// Screen rows are allocated on first write. A row holds width characters,
+// then width modes, then width colours. A null row is blank.
+char   **row_ptr        = 0;
+char    *row_blank      = 0;   // shared blank row, never written to
+char    *row_free       = 0;   // recycled rows, linked through their first bytes
+char    *row_arena      = 0;   // rows are carved ROW_ARENA at a time from here
+int32_t  row_arena_left = 0;
+size_t   row_bytes      = 0;
 char *colour_names[] = {"#000000", "#bb0000", "#00bb00", "#bbbb00", "#0000bb", "#bb00bb", "#00bbbb", "#cccccc", // normal
                         "#555555", "#ff0000", "#00ff00", "#ffff00", "#0000ff", "#ff00ff", "#00ffff", "#ffffff", // bright fg
                         "#000000", "#660000", "#006600", "#666600", "#000066", "#660066", "#006666", "#999999", // dim fg
@@ -94,10 +104,87 @@ static void usage(void) {
   (void)fflush (stderr);
 }
 
-void clear_cells(int32_t start, int32_t len){//(char* b1, char* b2, char* b3, int32_t start, int32_t len){
-  (void)memset(out     + start, 32, len);                       // ' '
-  (void)memset(out_mode+ start, 0,  len);                       // mode = 0
-  (void)memset(out_col + start, m_white + m_black >> 4, len);   // fg white, bg black 
+static void blank_cells(char *row, int32_t start, int32_t len){
+  (void)memset(row           + start, 32, len);                       // ' '
+  (void)memset(row +   width + start, 0,  len);                       // mode = 0
+  (void)memset(row + 2*width + start, m_white + m_black >> 4, len);   // fg white, bg black 
+}
+
+
+/*----------------------------------------*/
+/* Return row y, allocating it if blank   */
+/*----------------------------------------*/
+
+static char *get_row(int32_t y){
+  char *row;
+
+  if (row_ptr[y])
+     return row_ptr[y];
+
+  if (row_free) {
+     row = row_free;
+     (void)memcpy(&row_free, row, sizeof(char*));
+  }
+
+  else {
+     if (row_arena_left == 0) {
+        row_arena = (char*) malloc(row_bytes*ROW_ARENA);
+
+        if (row_arena == 0) {
+           (void)fprintf(stderr,"Memory allocation failure.\n");
+           (void)fflush (stderr);
+
+           exit(255);
+        }
+
+        row_arena_left = ROW_ARENA;
+     }
+
+     row             = row_arena;
+     row_arena      += row_bytes;
+     row_arena_left -= 1;
+  }
+
+  blank_cells(row, 0, width);
+  row_ptr[y] = row;
+
+  return row;
+}
+
+
+/*----------------------------------------*/
+/* Blank row y and recycle its storage    */
+/*----------------------------------------*/
+
+static void release_row(int32_t y){
+
+  if (row_ptr[y]) {
+     (void)memcpy(row_ptr[y], &row_free, sizeof(char*));
+     row_free   = row_ptr[y];
+     row_ptr[y] = 0;
+  }
+}
+
+
+void clear_cells(int32_t start, int32_t len){
+  int32_t y, x, n;
+
+  while ((len > 0) && (start / width < height)) {
+    y = start / width;
+    x = start % width;
+    n = width - x;
+
+    if (n > len)
+       n = len;
+
+    if (n == width)
+       release_row(y);                   // whole row, so it becomes blank
+    else if (row_ptr[y])
+       blank_cells(row_ptr[y], x, n);    // untouched rows are already blank
+
+    start += n;
+    len   -= n;
+  }
 }
 
 void print_line(int32_t line);
@@ -105,6 +192,7 @@ void print_line(int32_t line);
 int32_t main(int32_t argc, char **argv)
 {
   int32_t loop, tmp;
+  char *row;
 
   progname = argv[0];
 
@@ -213,21 +301,23 @@ int32_t main(int32_t argc, char **argv)
   if (argc < 1)
      use_stdin = 1;
 
-  out      = (char*) malloc(width*height);
-  out_mode = (char*) malloc(width*height);
-  out_col  = (char*) malloc(width*height);
-  out_size = (char*) malloc(height);
-  
-  // cls
-  clear_cells(0, width*height);//out, out_mode, out_col, 0, width*height);
-  (void)memset(out_size, 0, height);
+  row_bytes = 3*(size_t)width;
+  if (row_bytes < sizeof(char*))
+     row_bytes = sizeof(char*);     // room for the free list link
+
+  // cls (rows are blank until written)
+  row_ptr   = (char**) calloc(height, sizeof(char*));
+  out_size  = (char*)  calloc(height, 1);
+  row_blank = (char*)  malloc(row_bytes);
   
-  if ((out==0)||(out_mode==0)||(out_col==0)||(out_size==0)) {
+  if ((row_ptr==0)||(out_size==0)||(row_blank==0)) {
     (void)fprintf(stderr,"Memory allocation failure.\n");
     (void)fflush (stderr);
 
     return 255;
   }
+
+  blank_cells(row_blank, 0, width);
   
   
   char vt100[VT100_BUF];
@@ -278,10 +368,10 @@ int32_t main(int32_t argc, char **argv)
     b = fgetc(f);
 
     if ((b > 31) && (b < 127)) {
-      tmp = cX + cY*width;
-      out[tmp] = b;
-      out_mode[tmp] = current_mode;
-      out_col [tmp] = current_col;
+      row = get_row(cY);
+      row[          cX] = b;
+      row[  width + cX] = current_mode;
+      row[2*width + cX] = current_col;
       cX++;
     }
     
@@ -295,7 +385,7 @@ int32_t main(int32_t argc, char **argv)
 
            case 12: // ^L form feed
                     for (cY = 0; cY <= max_cY; cY++) print_line(cY);
-                    clear_cells(0, width*height);//out, out_mode, out_col, 0, width*height);
+                    clear_cells(0, width*height);
                     (void)memset(out_size, 0, height);
                     cX = 0; cY = 0; max_cX = 0; max_cY = 0;
                     break;
@@ -465,14 +555,14 @@ int32_t main(int32_t argc, char **argv)
 	 tmp = height - 1;
 
       for (loop = 0; loop < tmp; loop++)
-	  print_line(loop);
+      {  print_line(loop);
+         release_row(loop);
+      }
 
-      (void)memmove(out     , out      + tmp*width, (height-tmp)*width);
-      (void)memmove(out_mode, out_mode + tmp*width, (height-tmp)*width);
-      (void)memmove(out_col , out_col  + tmp*width, (height-tmp)*width);
-      (void)memmove(out_size, out_size + tmp      ,  height-tmp       );
+      (void)memmove(row_ptr , row_ptr  + tmp, (height-tmp)*sizeof(char*));
+      (void)memmove(out_size, out_size + tmp,  height-tmp               );
 
-      clear_cells( (height-tmp)*width, tmp*width);
+      (void)memset(row_ptr + height - tmp, 0, tmp*sizeof(char*));
       
       cY = height - 1;
     }
@@ -511,7 +601,9 @@ void print_line(int32_t line)
   int32_t current_mode = -1;
   int32_t current_col  = -1;
   int32_t cX, cY       = line;
-  int32_t tmp          = cY*width;
+  int32_t tmp          = 0;
+  char *row            = (row_ptr[cY]) ? row_ptr[cY] : row_blank;
+  char *out, *out_mode, *out_col;
 
     if (out_size[cY]&mode_wide)
        wide_set = 1;
@@ -536,7 +628,16 @@ void print_line(int32_t line)
     }
 
     for (cX = 0; cX <= max_cX; cX++) {
-      tmp = cX + cY*width;
+      if (cX < width)
+         tmp = cX;
+      else
+      {  row = row_blank;    // past the right edge of a wide line
+         tmp = 0;
+      }
+
+      out      = row;
+      out_mode = row +   width;
+      out_col  = row + 2*width;
 
       if (html_mode)
         if ((current_mode != out_mode[tmp]) || (current_col != out_col[tmp])) {